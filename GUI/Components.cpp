@@ -10,116 +10,187 @@ namespace MyJUCEModules {
 	{
 		path.addTriangle(0.0f, 0.0f, 0.0f, 1.0f, 1.0f, 0.5f);
 		path.applyTransform(juce::AffineTransform::rotation(juce::MathConstants<float>::twoPi * arrowDirection, 0.5f, 0.5f));
+		updateCachedColours();
 	}
 
 	ArrowButton::~ArrowButton() {}
 
 	void ArrowButton::paintButton(juce::Graphics& g, bool shouldDrawButtonAsHighlighted, bool shouldDrawButtonAsDown)
 	{
-		juce::Path p(path);
-		juce::Colour colourToUse;
-
 		if (shouldDrawButtonAsDown)
-			colourToUse = colour.brighter();
+			g.setColour(downColour);
 		else if (shouldDrawButtonAsHighlighted)
-			colourToUse = colour.darker();
+			g.setColour(overColour);
 		else
-			colourToUse = colour;
-
-		p.applyTransform(path.getTransformToScaleToFit(0.0f, 0.0f, (float)getWidth(), (float)getHeight(), false));
+			g.setColour(normalColour);
 
-		g.setColour(colourToUse);
 		if (!this->isEnabled())
 			g.setOpacity(0.5f);
-		g.fillPath(p);
+		g.fillPath(scaledPath);
 	}
 
-	// =====================================  MyTextButton  ================================================
+	void ArrowButton::resized()
+	{
+		scaledPath = path;
+		scaledPath.applyTransform(path.getTransformToScaleToFit(0.0f, 0.0f, (float)getWidth(), (float)getHeight(), false));
+	}
 
-	void MyTextButton::paintButton(juce::Graphics& g, bool isMouseOverButton, bool isButtonDown) {
-		juce::Colour colourToUse = colour;
-		auto toggleState = getToggleState();
+	void ArrowButton::setArrowColour(juce::Colour newColour)
+	{
+		colour = newColour;
+		updateCachedColours();
+		repaint();
+	}
+
+	void ArrowButton::updateCachedColours()
+	{
+		normalColour = colour;
+		overColour = colour.darker();
+		downColour = colour.brighter();
+	}
 
-		if (isMouseOverButton)
-			colourToUse = colour.darker();
+	// =====================================  MyTextButton  ================================================
 
+	void MyTextButton::paintButton(juce::Graphics& g, bool isMouseOverButton, bool isButtonDown) {
+		const auto& colourToUse = isMouseOverButton ? overColour : normalColour;
 		g.setColour(colourToUse.withMultipliedAlpha(this->isEnabled() ? 1.0f : 0.5f));
 
-		juce::Font fontTouUSe = font;
-		if (isButtonDown || toggleState){
-			fontTouUSe = font.boldened();
-			g.setFont(fontTouUSe.withHeight(getHeight() * 0.7f));
-		}
+		if (isButtonDown || getToggleState())
+			g.setFont(boldFont);
 		else
-			g.setFont(fontTouUSe.withHeight(getHeight() * 0.7f));
-		
+			g.setFont(plainFont);
 
-		juce::String buttonText = getButtonText();
+		const auto& buttonText = getButtonText();
 
-		if (buttonText.length() > 0)
+		if (buttonText.isNotEmpty())
 			g.drawText(buttonText, getLocalBounds(), juce::Justification::centred);
 	}
 
+	void MyTextButton::resized() {
+		juce::TextButton::resized();
+		updateCachedFonts();
+	}
+
+	void MyTextButton::updateCachedFonts() {
+		plainFont = font.withHeight(getHeight() * 0.7f);
+		boldFont = plainFont.boldened();
+		repaint();
+	}
+
+	void MyTextButton::updateCachedColours() {
+		normalColour = colour;
+		overColour = colour.darker();
+		repaint();
+	}
+
+
+    // =====================================  PluginPanelResources  ================================================
+
+	namespace {
+		struct IconData { const char* data; int size; };
+
+		const std::array<IconData, PluginPanelResources::numIcons> iconData{ {
+			{ BinaryData::arrowgobackline_svg, BinaryData::arrowgobackline_svgSize },
+			{ BinaryData::arrowgoforwardline_svg, BinaryData::arrowgoforwardline_svgSize },
+			{ BinaryData::filecopyline_svg, BinaryData::filecopyline_svgSize },
+			{ BinaryData::menuline_svg, BinaryData::menuline_svgSize },
+			{ BinaryData::hqline_svg, BinaryData::hqline_svgSize },
+			{ BinaryData::shutdownline_svg, BinaryData::shutdownline_svgSize }
+		} };
+	}
+
+	void PluginPanelResources::parseIcons() {
+		const juce::ScopedLock sl(svgLock);
+		for (size_t i = 0; i < svgs.size(); i++)
+			if (svgs[i] == nullptr)
+				svgs[i] = juce::parseXML(juce::String::createStringFromData(iconData[i].data, iconData[i].size));
+	}
+
+	const juce::Drawable& PluginPanelResources::getIcon(Icon icon) {
+		JUCE_ASSERT_MESSAGE_THREAD
+		auto& drawable = drawables[(size_t)icon];
+		if (drawable == nullptr) {
+			parseIcons();
+			const juce::ScopedLock sl(svgLock);
+			if (auto& svg = svgs[(size_t)icon])
+				drawable = juce::Drawable::createFromSVG(*svg);
+			if (drawable == nullptr) {
+				jassertfalse;
+				drawable = std::make_unique<juce::DrawableComposite>();
+			}
+		}
+		return *drawable;
+	}
 
     // =====================================  PluginPanel  ================================================
 
+	namespace {
+		/**
+		*   @brief Scans a preset directory one entry at a time and hands the result to onScanned, unless the pool asked it to exit first.
+		*	Closing the last panel destroys the shared pool, which then only waits for the directory entry being read instead of the whole scan.
+		**/
+		class PresetScanJob : public juce::ThreadPoolJob
+		{
+		public:
+			PresetScanJob(juce::File presetDirectory, juce::String presetExtension, std::function<void(const juce::StringArray&)> scannedCallback) :
+				juce::ThreadPoolJob("Preset scan"), directory(std::move(presetDirectory)), extension(std::move(presetExtension)), onScanned(std::move(scannedCallback)) {}
+
+			JobStatus runJob() override {
+				const auto presets = PresetManager::findPresets(directory, extension, [this] { return shouldExit(); });
+				if (!shouldExit())
+					onScanned(presets);
+				return jobHasFinished;
+			}
+
+		private:
+			const juce::File directory;
+			const juce::String extension;
+			const std::function<void(const juce::StringArray&)> onScanned;
+		};
+	}
+
 	PluginPanel::PluginPanel(PresetManager& pm, juce::UndoManager& uM, juce::AudioProcessorValueTreeState& apvts):
 		presetManager(pm), undoManager(uM), pluginApvts(apvts),
 		previousPresetButton("Previous", 0.5f, juce::Colours::gainsboro.darker().darker().darker().darker()),
 		nextPresetButton("Next", 1.0f, juce::Colours::gainsboro.darker().darker().darker().darker())
 	{
 		undoManager.addChangeListener(this);
+		presetManager.addChangeListener(this);
 		tooltipWindow->setLookAndFeel(&lookAndFeel);
 
-		undoIcon = juce::Drawable::createFromImageData(BinaryData::arrowgobackline_svg, BinaryData::arrowgobackline_svgSize);
-		configureIconButton(undoButton, undoIcon->createCopy());
+		configureIconButton(undoButton);
 		undoButton.setTooltip("Undo");
 		undoButton.setEnabled(false);
-		redoIcon = juce::Drawable::createFromImageData(BinaryData::arrowgoforwardline_svg, BinaryData::arrowgobackline_svgSize);
-		configureIconButton(redoButton, redoIcon->createCopy());
+		configureIconButton(redoButton);
 		redoButton.setEnabled(false);
 		redoButton.setTooltip("Redo");
 
-		copyIcon = juce::Drawable::createFromImageData(BinaryData::filecopyline_svg, BinaryData::filecopyline_svgSize);
-		configureIconButton(copyButton, copyIcon->createCopy());
+		configureIconButton(copyButton);
 		copyButton.setTooltip("Copy current configuration to clipboard");
 
-		oversamplingIcon = juce::Drawable::createFromImageData(BinaryData::hqline_svg, BinaryData::hqline_svgSize);
-		configureIconButton(oversamplingButton, oversamplingIcon->createCopy());
+		configureIconButton(oversamplingButton);
 		oversamplingButton.setTooltip("Configure oversampling");
 		
 		configureArrowButton(previousPresetButton);
 		previousPresetButton.setTooltip("Previous preset");
-		configureComboBox(presetComboBox, "No preset");
+		configureComboBox(presetComboBox, "Loading presets...");
 		presetComboBox.setTooltip("Select a preset");
+		presetComboBox.setJustificationType(juce::Justification::centred);
 		configureArrowButton(nextPresetButton);
 		nextPresetButton.setTooltip("Next preset");
 		
-		optionsIcon = juce::Drawable::createFromImageData(BinaryData::menuline_svg, BinaryData::menuline_svgSize);
-		configureIconButton(optionsButton, optionsIcon->createCopy());
+		configureIconButton(optionsButton);
 		optionsButton.setTooltip("More...");
 		
 		configureTextButton(aButton, "A");
 		aButton.setClickingTogglesState(true);
-		aButton.setToggleState(true, juce::dontSendNotification);
 		aButton.setTooltip("Switch to configuration A");
 		configureTextButton(copyAtoBButton, ">");
-		copyAtoBButton.setTooltip("Copy current configuration to B");
 		configureTextButton(bButton, "B");
 		bButton.setClickingTogglesState(true);
 		bButton.setTooltip("Switch to configuration B");
+		updateConfigButtons();
 		
-		bypassIcon= juce::Drawable::createFromImageData(BinaryData::shutdownline_svg, BinaryData::shutdownline_svgSize);
-		
-		bypassIcon->replaceColour(juce::Colours::black, textBaseColour);
-		auto normalImage = bypassIcon->createCopy();
-		auto overImage = normalImage->createCopy();
-		overImage->replaceColour(textBaseColour, textBaseColour.darker());
-		auto downImage = normalImage->createCopy();
-		downImage->replaceColour(textBaseColour, textBaseColour.brighter());
-		auto normalImageDown = normalImage->createCopy();
-		normalImageDown->replaceColour(textBaseColour, textBaseColour.brighter());
-		bypassButton.setImages(normalImage.get(), overImage.get(), downImage.get(), nullptr, normalImageDown.get(), normalImageDown.get(), normalImageDown.get(), nullptr);
 		bypassButton.setColour(juce::DrawableButton::ColourIds::backgroundColourId, juce::Colours::gainsboro.darker());
 		bypassButton.setColour(juce::DrawableButton::ColourIds::backgroundOnColourId, juce::Colours::gainsboro.darker());
 		bypassButton.setMouseCursor(juce::MouseCursor::PointingHandCursor);
@@ -128,17 +199,18 @@ namespace MyJUCEModules {
 		bypassButton.setTooltip("Toggle plugin bypass");
 		bypassAttachment = std::make_unique<juce::AudioProcessorValueTreeState::ButtonAttachment>(pluginApvts, g_bypassID, bypassButton);
 
-		const auto allPresets = presetManager.getAllPresets();
-		const auto currentPreset = presetManager.getCurrentPresetName();
-		presetComboBox.setJustificationType(juce::Justification::centred);
-		presetComboBox.addItemList(allPresets, 1);
-		presetComboBox.setSelectedItemIndex(allPresets.indexOf(currentPreset), juce::dontSendNotification);
+		presetManager.initialiseOtherConfig();
 
-		presetManager.copyCurrentConfigToOther();
+		// Icons and the preset list are attached once they are ready, without holding up the editor.
+		loadIcons();
+		refreshPresetList();
 	}
 
 	PluginPanel::~PluginPanel() {
+		stopTimer();
+
 		undoManager.removeChangeListener(this);
+		presetManager.removeChangeListener(this);
 
 		tooltipWindow->setLookAndFeel(nullptr);
 
@@ -258,29 +330,19 @@ namespace MyJUCEModules {
 		}
 		else if (button == &previousPresetButton) {
 			presetManager.loadPreviousPreset();
-			const auto allPresets = presetManager.getAllPresets();
-			const auto currentPreset = presetManager.getCurrentPresetName();
-			presetComboBox.setSelectedItemIndex(allPresets.indexOf(currentPreset), juce::dontSendNotification);
+			selectCurrentPreset();
 		}
 		else if (button == &nextPresetButton) {
 			presetManager.loadNextPreset();
-			const auto allPresets = presetManager.getAllPresets();
-			const auto currentPreset = presetManager.getCurrentPresetName();
-			presetComboBox.setSelectedItemIndex(allPresets.indexOf(currentPreset), juce::dontSendNotification);
+			selectCurrentPreset();
 		}
 		else if (button == &aButton) {
 			presetManager.switchToConfig("A");
-			bButton.setToggleState(false, juce::dontSendNotification);
-			aButton.setToggleState(true, juce::dontSendNotification);
-			copyAtoBButton.setButtonText(">");
-			copyAtoBButton.setTooltip("Copy current configuration to B");
+			updateConfigButtons();
 		}
 		else if (button == &bButton) {
 			presetManager.switchToConfig("B");
-			bButton.setToggleState(true, juce::dontSendNotification);
-			aButton.setToggleState(false, juce::dontSendNotification);
-			copyAtoBButton.setButtonText("<");
-			copyAtoBButton.setTooltip("Copy current configuration to A");
+			updateConfigButtons();
 		}
 		else if (button == &copyAtoBButton) {
 			presetManager.copyCurrentConfigToOther();
@@ -293,9 +355,7 @@ namespace MyJUCEModules {
 				presetFileChooser->launchAsync(juce::FileBrowserComponent::openMode | juce::FileBrowserComponent::canSelectFiles, [&](const juce::FileChooser& fc) {
 					const auto file = fc.getResult();
 					presetManager.loadPreset(file);
-					const auto allPresets = presetManager.getAllPresets();
-					const auto currentPreset = presetManager.getCurrentPresetName();
-					presetComboBox.setSelectedItemIndex(allPresets.indexOf(currentPreset), juce::dontSendNotification);
+					selectCurrentPreset();
 				});
 			});
 			m.addItem("Save", [this] {
@@ -303,13 +363,7 @@ namespace MyJUCEModules {
 				presetFileChooser->launchAsync(juce::FileBrowserComponent::saveMode | juce::FileBrowserComponent::warnAboutOverwriting, [&](const juce::FileChooser& fc) {
 					const auto file = fc.getResult();
 					presetManager.savePreset(file);
-
-					const auto allPresets = presetManager.getAllPresets();
-					const auto currentPreset = presetManager.getCurrentPresetName();
-
-					presetComboBox.clear(juce::dontSendNotification);
-					presetComboBox.addItemList(allPresets, 1);
-					presetComboBox.setSelectedItemIndex(allPresets.indexOf(currentPreset), juce::dontSendNotification);
+					refreshPresetList();
 				});
 			});
 			auto clipboardText = juce::SystemClipboard::getTextFromClipboard();
@@ -347,19 +401,32 @@ namespace MyJUCEModules {
 		}
 	}
 
-	void PluginPanel::configureIconButton(juce::Button& button, std::unique_ptr<juce::Drawable> icon) {
-		icon->replaceColour(juce::Colours::black, textBaseColour);
-		auto normalImage = icon->createCopy();
+	void PluginPanel::configureIconButton(juce::Button& button) {
+		button.setMouseCursor(juce::MouseCursor::PointingHandCursor);
+		addAndMakeVisible(button);
+		button.addListener(this);
+	}
+
+	void PluginPanel::attachIcon(juce::DrawableButton& button, const juce::Drawable& icon) {
+		auto normalImage = icon.createCopy();
+		normalImage->replaceColour(juce::Colours::black, textBaseColour);
 		auto overImage = normalImage->createCopy();
 		overImage->replaceColour(textBaseColour, textBaseColour.darker());
 		auto downImage = normalImage->createCopy();
 		downImage->replaceColour(textBaseColour, textBaseColour.brighter());
-		auto iconButton = dynamic_cast<juce::DrawableButton*>(&button);
-		iconButton->setImages(normalImage.get(), overImage.get(), downImage.get());
+		button.setImages(normalImage.get(), overImage.get(), downImage.get());
+	}
 
-		button.setMouseCursor(juce::MouseCursor::PointingHandCursor);
-		addAndMakeVisible(button);
-		button.addListener(this);
+	void PluginPanel::attachBypassIcon(const juce::Drawable& icon) {
+		auto normalImage = icon.createCopy();
+		normalImage->replaceColour(juce::Colours::black, textBaseColour);
+		auto overImage = normalImage->createCopy();
+		overImage->replaceColour(textBaseColour, textBaseColour.darker());
+		auto downImage = normalImage->createCopy();
+		downImage->replaceColour(textBaseColour, textBaseColour.brighter());
+		auto normalImageDown = normalImage->createCopy();
+		normalImageDown->replaceColour(textBaseColour, textBaseColour.brighter());
+		bypassButton.setImages(normalImage.get(), overImage.get(), downImage.get(), nullptr, normalImageDown.get(), normalImageDown.get(), normalImageDown.get(), nullptr);
 	}
 
 	void PluginPanel::configureTextButton(MyJUCEModules::MyTextButton& button, const juce::String& buttonText) {
@@ -392,5 +459,85 @@ namespace MyJUCEModules {
 			undoButton.setEnabled(undoManager.canUndo());
 			redoButton.setEnabled(undoManager.canRedo());
 		}
+		else if (source == &presetManager) {
+			// Also covers a state restored by the host while the editor is open.
+			updateConfigButtons();
+			selectCurrentPreset();
+		}
+	}
+
+	void PluginPanel::updateConfigButtons() {
+		const auto isConfigB = presetManager.getCurrentConfig() == "B";
+		aButton.setToggleState(!isConfigB, juce::dontSendNotification);
+		bButton.setToggleState(isConfigB, juce::dontSendNotification);
+		copyAtoBButton.setButtonText(isConfigB ? "<" : ">");
+		copyAtoBButton.setTooltip(isConfigB ? "Copy current configuration to A" : "Copy current configuration to B");
+	}
+
+	void PluginPanel::loadIcons() {
+		juce::Component::SafePointer<PluginPanel> safeThis(this);
+		auto& resources = sharedResources.get();
+		// The pool is owned by the resources and drains before they are destroyed, so the job can refer to them.
+		resources.getThreadPool().addJob([safeThis, &resources] {
+			resources.parseIcons();
+			juce::MessageManager::callAsync([safeThis] {
+				if (safeThis != nullptr)
+					safeThis->attachIcons();
+			});
+		});
+	}
+
+	void PluginPanel::attachIcons() {
+		auto& resources = sharedResources.get();
+		attachIcon(undoButton, resources.getIcon(PluginPanelResources::undoIcon));
+		attachIcon(redoButton, resources.getIcon(PluginPanelResources::redoIcon));
+		attachIcon(copyButton, resources.getIcon(PluginPanelResources::copyIcon));
+		attachIcon(oversamplingButton, resources.getIcon(PluginPanelResources::oversamplingIcon));
+		attachIcon(optionsButton, resources.getIcon(PluginPanelResources::optionsIcon));
+		attachBypassIcon(resources.getIcon(PluginPanelResources::bypassIcon));
+	}
+
+	void PluginPanel::refreshPresetList() {
+		stopTimer();
+		const auto scanId = ++latestPresetScanId;
+
+		// Fire and forget: a panel closed before the scan finishes just never receives the result.
+		juce::Component::SafePointer<PluginPanel> safeThis(this);
+		sharedResources->getThreadPool().addJob(new PresetScanJob(presetManager.defaultDirectory, presetManager.extension, [safeThis, scanId](const juce::StringArray& presets) {
+			juce::MessageManager::callAsync([safeThis, scanId, presets] {
+				if (safeThis != nullptr)
+					safeThis->presetListScanned(presets, scanId);
+			});
+		}), true);
+	}
+
+	void PluginPanel::presetListScanned(const juce::StringArray& presets, int scanId) {
+		if (scanId != latestPresetScanId)
+			return;
+
+		scannedPresets = presets;
+		numPresetsAdded = 0;
+		presetComboBox.clear(juce::dontSendNotification);
+		timerCallback();
+	}
+
+	void PluginPanel::timerCallback() {
+		const auto numToAdd = juce::jmin(presetsAddedPerTick, scannedPresets.size() - numPresetsAdded);
+		for (auto i = 0; i < numToAdd; i++, numPresetsAdded++)
+			presetComboBox.addItem(scannedPresets[numPresetsAdded], numPresetsAdded + 1);
+
+		if (numPresetsAdded < scannedPresets.size()) {
+			if (!isTimerRunning())
+				startTimer(10);
+			return;
+		}
+
+		stopTimer();
+		presetComboBox.setTextWhenNothingSelected("No preset");
+		selectCurrentPreset();
+	}
+
+	void PluginPanel::selectCurrentPreset() {
+		presetComboBox.setSelectedItemIndex(scannedPresets.indexOf(presetManager.getCurrentPresetName()), juce::dontSendNotification);
 	}
 }
@@ -21,11 +21,23 @@ namespace MyJUCEModules {
         ArrowButton(const juce::String& buttonName, float arrowDirection, juce::Colour arrowColour);
         ~ArrowButton() override;
         void paintButton(juce::Graphics&, bool, bool) override;
+        void resized() override;
+
+        /**
+        *   @brief Changes the arrow colour and refreshes the cached colours for each button state.
+        **/
+        void setArrowColour(juce::Colour newColour);
 
     private:
+        void updateCachedColours();
+
         juce::Colour colour;
         juce::Path path;
 
+        // Arrow path scaled to the current bounds and colours per button state, rebuilt on resize or colour change.
+        juce::Path scaledPath;
+        juce::Colour normalColour, overColour, downColour;
+
         JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ArrowButton)
     };
 
@@ -38,18 +50,53 @@ namespace MyJUCEModules {
     public:
         using juce::TextButton::TextButton;
         void paintButton(juce::Graphics& g, bool isMouseOverButton, bool isButtonDown) override;
-        void setFont(juce::Font font) { this->font = font; }
-        void setColour(juce::Colour colour) { this->colour = colour; }
+        void resized() override;
+        void setFont(juce::Font font) { this->font = font; updateCachedFonts(); }
+        void setColour(juce::Colour colour) { this->colour = colour; updateCachedColours(); }
     private:
+        void updateCachedFonts();
+        void updateCachedColours();
+
         juce::Font font;
         juce::Colour colour = juce::Colours::gainsboro.darker().darker().darker().darker();
+
+        // Fonts sized to the current height and colours per button state, rebuilt on resize, font or colour change.
+        juce::Font plainFont, boldFont;
+        juce::Colour normalColour = colour, overColour = colour.darker();
+    };
+
+    // ====================== PLUGIN PANEL ICONS ======================
+    /**
+    *   @brief Resources shared by all open PluginPanels through a SharedResourcePointer: one background thread and the panel icons.
+    *   The icons' SVG data is parsed on the background thread. Drawables are Components, so they are built from the parsed SVG on the message thread, once.
+    **/
+    class PluginPanelResources
+    {
+    public:
+        enum Icon { undoIcon, redoIcon, copyIcon, optionsIcon, oversamplingIcon, bypassIcon, numIcons };
+
+        /** Parses the SVG data of the icons that have not been parsed yet. Can be called from any thread. */
+        void parseIcons();
+        /** Returns an icon, building its Drawable on first use. Message thread only. */
+        const juce::Drawable& getIcon(Icon icon);
+        /** Background thread for the panels' file and parsing work. Jobs must not wait on the message thread, and long ones must check shouldExit(). */
+        juce::ThreadPool& getThreadPool() { return threadPool; }
+
+    private:
+        juce::CriticalSection svgLock;
+        std::array<std::unique_ptr<juce::XmlElement>, numIcons> svgs;
+        std::array<std::unique_ptr<juce::Drawable>, numIcons> drawables;
+
+        // Declared last so that it is destroyed first, while the members above still exist. Its destructor asks running jobs to exit and waits for them.
+        juce::ThreadPool threadPool{ 1 };
     };
 
     // ====================== PLUGIN PANEL ======================
     /**
     *   @brief Top panel containing the GUI elements for the Preset Manager, undo/redo, resize and A/B configurations functionalities as well as the logo and plugin's version number.
+    *   Icons are attached right after construction and the preset list is scanned on a background thread and added to the combo box in batches, so the panel shows up without waiting for them.
     **/
-    class PluginPanel : public juce::Component, juce::Button::Listener, juce::ComboBox::Listener, juce::ChangeListener
+    class PluginPanel : public juce::Component, juce::Button::Listener, juce::ComboBox::Listener, juce::ChangeListener, juce::Timer
     {
     public:
         /**
@@ -66,12 +113,25 @@ namespace MyJUCEModules {
         void buttonClicked(juce::Button* button) override;
         void comboBoxChanged(juce::ComboBox* comboBox) override;
         void configureComboBox(juce::ComboBox& comboBox, const juce::String& textWhenNothingSelected);
-        void configureIconButton(juce::Button& button, std::unique_ptr<juce::Drawable> icon);
+        void configureIconButton(juce::Button& button);
         void configureTextButton(MyJUCEModules::MyTextButton& button, const juce::String& buttonText);
         void configureArrowButton(juce::Button& button);
+        void attachIcon(juce::DrawableButton& button, const juce::Drawable& icon);
+        void attachBypassIcon(const juce::Drawable& icon);
 
         void changeListenerCallback(juce::ChangeBroadcaster* source) override;
 
+        /** Parses the icons on the shared background thread and attaches them when done. */
+        void loadIcons();
+        void attachIcons();
+        /** Adds the next batch of scanned presets to the combo box. */
+        void timerCallback() override;
+
+        void updateConfigButtons();
+        void refreshPresetList();
+        void presetListScanned(const juce::StringArray& presets, int scanId);
+        void selectCurrentPreset();
+
         PresetManager& presetManager;
         juce::UndoManager& undoManager;
         juce::AudioProcessorValueTreeState& pluginApvts;
@@ -81,7 +141,7 @@ namespace MyJUCEModules {
         juce::String pluginName = "  " + juce::String(JucePlugin_Name) + " ";
         juce::String pluginVersion = " v" + juce::String(JucePlugin_VersionString);
 
-        std::unique_ptr<juce::Drawable> undoIcon, redoIcon, copyIcon, optionsIcon, oversamplingIcon, bypassIcon;
+        juce::SharedResourcePointer<PluginPanelResources> sharedResources;
 
         juce::DrawableButton undoButton{ "undo", juce::DrawableButton::ButtonStyle::ImageFitted }, redoButton{ "redo", juce::DrawableButton::ButtonStyle::ImageFitted },
             copyButton{ "copy", juce::DrawableButton::ButtonStyle::ImageFitted }, optionsButton{ "options", juce::DrawableButton::ButtonStyle::ImageFitted },
@@ -97,6 +157,11 @@ namespace MyJUCEModules {
         
         std::unique_ptr<juce::FileChooser> presetFileChooser;
 
+        int latestPresetScanId = 0;
+        juce::StringArray scannedPresets;
+        int numPresetsAdded = 0;
+        static constexpr int presetsAddedPerTick = 32;
+
         juce::Colour textBaseColour = juce::Colours::gainsboro.darker().darker().darker().darker();
 
         PluginPanelLookAndFeel lookAndFeel;
@@ -32,21 +32,15 @@ namespace MyJUCEModules {
     
     void PluginPanelLookAndFeel::drawComboBox(juce::Graphics& g, int width, int height, bool isButtonDown, int buttonX, int buttonY, int buttonW, int buttonH, juce::ComboBox& box) {
         juce::Rectangle<int> boxBounds(0, 0, width, height);
-        juce::Path path;
-
-        auto bounds = boxBounds.toFloat().reduced(0.5f, 0.5f);
-        
-        path.addRoundedRectangle(bounds.getX(), bounds.getY(),
-            bounds.getWidth(), bounds.getHeight(),
-            cornerSize, cornerSize, true, true, true, true);
+        const auto& outline = getCachedOutline(boxBounds.toFloat().reduced(0.5f, 0.5f), 0);
         
         g.setColour(box.findColour(juce::ComboBox::backgroundColourId));
         if (!box.isEnabled())
             g.setOpacity(0.5f);
-        g.fillPath(path);
+        g.fillPath(outline.fill);
 
         g.setColour(box.findColour(juce::ComboBox::outlineColourId));
-        g.strokePath(path, juce::PathStrokeType(1.5f));
+        g.fillPath(outline.stroke);
     };
 
     void PluginPanelLookAndFeel::drawButtonBackground(juce::Graphics& g, juce::Button& button, const juce::Colour& backgroundColour, bool shouldDrawButtonAsHighlighted, bool shouldDrawButtonAsDown) {
@@ -62,39 +56,53 @@ namespace MyJUCEModules {
             g.setOpacity(0.5f);
         g.setColour(baseColour);
 
-        auto flatOnLeft = button.isConnectedOnLeft();
-        auto flatOnRight = button.isConnectedOnRight();
-        auto flatOnTop = button.isConnectedOnTop();
-        auto flatOnBottom = button.isConnectedOnBottom();
-
-        if (flatOnLeft || flatOnRight || flatOnTop || flatOnBottom)
-        {
-            juce::Path path;
-            path.addRoundedRectangle(bounds.getX(), bounds.getY(),
-                bounds.getWidth(), bounds.getHeight(),
-                cornerSize, cornerSize,
-                !(flatOnLeft || flatOnTop),
-                !(flatOnRight || flatOnTop),
-                !(flatOnLeft || flatOnBottom),
-                !(flatOnRight || flatOnBottom));
-
-            g.fillPath(path);
-
-            g.setColour(button.findColour(juce::TextButton::buttonColourId));
-            g.strokePath(path, juce::PathStrokeType(1.5f));
-        }
-        else
-        {
-            g.fillRoundedRectangle(bounds, cornerSize);
-
-            g.setColour(button.findColour(juce::TextButton::buttonColourId));
-            g.drawRoundedRectangle(bounds, cornerSize, 1.5f);
-        }
+        int flatEdges = 0;
+        if (button.isConnectedOnLeft())   flatEdges |= flatLeft;
+        if (button.isConnectedOnRight())  flatEdges |= flatRight;
+        if (button.isConnectedOnTop())    flatEdges |= flatTop;
+        if (button.isConnectedOnBottom()) flatEdges |= flatBottom;
+
+        const auto& outline = getCachedOutline(bounds, flatEdges);
+        g.fillPath(outline.fill);
+
+        g.setColour(button.findColour(juce::TextButton::buttonColourId));
+        g.fillPath(outline.stroke);
     };
+
     void PluginPanelLookAndFeel::setCornerSize(float cornerSize) {
+        if (this->cornerSize == cornerSize)
+            return;
+
         this->cornerSize = cornerSize;
+        outlineCache.clearQuick();
     };
 
+    const PluginPanelLookAndFeel::CachedOutline& PluginPanelLookAndFeel::getCachedOutline(juce::Rectangle<float> bounds, int flatEdges) {
+        for (const auto& outline : outlineCache)
+            if (outline.bounds == bounds && outline.cornerSize == cornerSize && outline.flatEdges == flatEdges)
+                return outline;
+
+        // Continuous resizing keeps producing new sizes, so start over rather than growing without bound.
+        if (outlineCache.size() >= maxCachedOutlines)
+            outlineCache.clearQuick();
+
+        CachedOutline outline;
+        outline.bounds = bounds;
+        outline.cornerSize = cornerSize;
+        outline.flatEdges = flatEdges;
+        outline.fill.addRoundedRectangle(bounds.getX(), bounds.getY(),
+            bounds.getWidth(), bounds.getHeight(),
+            cornerSize, cornerSize,
+            !(flatEdges & (flatLeft | flatTop)),
+            !(flatEdges & (flatRight | flatTop)),
+            !(flatEdges & (flatLeft | flatBottom)),
+            !(flatEdges & (flatRight | flatBottom)));
+        juce::PathStrokeType(outlineThickness).createStrokedPath(outline.stroke, outline.fill);
+
+        outlineCache.add(std::move(outline));
+        return outlineCache.getReference(outlineCache.size() - 1);
+    }
+
     void PluginPanelLookAndFeel::drawImageButton(juce::Graphics& g, juce::Image* image, int imageX, int imageY, int imageW, int imageH, const juce::Colour& overlayColour, float imageOpacity, juce::ImageButton&) {
         juce::AffineTransform t = juce::RectanglePlacement(juce::RectanglePlacement::stretchToFit)
             .getTransformToFit(image->getBounds().toFloat(),
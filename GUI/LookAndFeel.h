@@ -20,7 +20,25 @@ namespace MyJUCEModules {
         void setCornerSize(float cornerSize);
         void drawImageButton(juce::Graphics&, juce::Image*, int imageX, int imageY, int imageW, int imageH, const juce::Colour& overlayColour, float imageOpacity, juce::ImageButton&) override;
     private:
+        /**
+        *   @brief Rounded-rectangle fill and stroke outline prepared for a given size, corner size and set of flat edges.
+        **/
+        struct CachedOutline {
+            juce::Rectangle<float> bounds;
+            float cornerSize = 0.0f;
+            int flatEdges = 0;
+            juce::Path fill, stroke;
+        };
+
+        enum FlatEdges { flatLeft = 1, flatRight = 2, flatTop = 4, flatBottom = 8 };
+
+        const CachedOutline& getCachedOutline(juce::Rectangle<float> bounds, int flatEdges);
+
+        static constexpr int maxCachedOutlines = 16;
+        static constexpr float outlineThickness = 1.5f;
+
         juce::Colour baseTextColour = juce::Colours::gainsboro.darker().darker().darker().darker();
         float cornerSize = 4.0f;
+        juce::Array<CachedOutline> outlineCache;
     };
 }
\ No newline at end of file
@@ -5,18 +5,58 @@
 namespace MyJUCEModules {
 	/**
 	*   @brief Preset manager class to manage the presets of the plugin and A/B states.
+	*	Preset, A/B and clipboard operations are meant for the message thread. getStateChunk(), setStateChunk() and the getters can also be called
+	*	from the host's state save/restore threads: a lock keeps the state, the other A/B configuration, the preset name and the config consistent
+	*	with each other, and is never held during file I/O or chunk encoding. The audio thread should read parameters through the
+	*	AudioProcessorValueTreeState, never through the preset manager.
+	*	replaceState() clears the AudioProcessorValueTreeState's UndoManager, which is not thread-safe and is shared with the UI. So when the
+	*	APVTS has one, setStateChunk() called off the message thread only decodes the chunk and applies it on the message thread. Until then
+	*	getStateChunk() and the getters report the restored chunk, and any message thread operation applies it first.
+	*	As with AudioProcessorValueTreeState::replaceState(), state listeners are called synchronously on the thread that changes the state.
+	*	JUCE's parameter attachments forward those calls to the message thread; other listeners touching the UI must do the same.
+	*	A change message is sent whenever the current preset name or A/B config changes, including when the host restores a state chunk.
+	*	Large binary properties loaded from a preset stay in their memory-mapped sidecar as SidecarData objects: read binary properties with
+	*	getBinaryProperty(), and use getStateChunk(), or embedBinaryData() on a copy of the state, to serialise it.
 	**/
-	class PresetManager {
+	class PresetManager : public juce::ChangeBroadcaster, private juce::AsyncUpdater {
 	public:
+		/**
+		*   @brief Binary property loaded from a preset sidecar. Keeps the sidecar mapped and points into it, so the data is only read from disk
+		*	when first accessed. Sidecars are never modified once written, so the data does not change under it.
+		**/
+		class SidecarData : public juce::ReferenceCountedObject {
+		public:
+			using Ptr = juce::ReferenceCountedObjectPtr<SidecarData>;
+
+			SidecarData(std::shared_ptr<juce::MemoryMappedFile> mappedSidecar, juce::int64 offset, size_t sizeInBytes)
+				: mappedFile(std::move(mappedSidecar)), data(juce::addBytesToPointer(mappedFile->getData(), offset)), size(sizeInBytes) {}
+
+			explicit SidecarData(juce::MemoryBlock block) : ownedBlock(std::move(block)), data(ownedBlock.getData()), size(ownedBlock.getSize()) {}
+
+			const void* getData() const noexcept { return data; }
+			size_t getSize() const noexcept { return size; }
+			juce::MemoryBlock toMemoryBlock() const { return { data, size }; }
+
+		private:
+			std::shared_ptr<juce::MemoryMappedFile> mappedFile;
+			juce::MemoryBlock ownedBlock;
+			const void* data = nullptr;
+			size_t size = 0;
+		};
+
 		const juce::File defaultDirectory;
 		const juce::String extension{ "preset" };
+		/** Extension of the sidecar files holding presets' large binary properties, stored next to the preset files. */
+		const juce::String binaryDataExtension{ "presetdata" };
+		/** Binary properties at least this large are written to a sidecar file instead of being embedded in the preset as base64. */
+		const size_t outOfLineBinarySize{ 64 * 1024 };
 
 		/**
 		*   @brief Preset manager class to manage the presets of the plugin and A/B states.
 		*	@param apvts Reference to the plugin's AudioProcessorValueTreeState to be affected by the preset manager.
 		*	@param dd Default directory to save and load presets from.
 		**/
-		PresetManager(juce::AudioProcessorValueTreeState& apvts, juce::File dd) : defaultDirectory(dd), valueTreeState(apvts)
+		PresetManager(juce::AudioProcessorValueTreeState& apvts, juce::File dd) : defaultDirectory(dd), valueTreeState(apvts), stateType(apvts.state.getType())
 		{
 			otherValueTree = valueTreeState.copyState();
 			if (!defaultDirectory.exists()) {
@@ -28,24 +68,56 @@ namespace MyJUCEModules {
 			}
 		}
 
+		/**
+		*   @brief Saves the current state to a preset file.
+		*	Large binary properties are streamed raw to a new sidecar file next to the preset, and the preset only holds small reference nodes
+		*	to them. A sidecar is never modified once written: each save writes a fresh one and removes the preset's older ones. Sidecars are named
+		*	<preset name>.<uuid>.<binaryDataExtension>, and only files named after the preset being saved or loaded are ever read or deleted for it.
+		*	On Windows a sidecar cannot be deleted while a loaded state still maps it, in which case a later save of the preset removes it.
+		**/
 		void savePreset(const juce::File& presetFile) {
 			if (presetFile.getFullPathName().isEmpty())
 				return;
 
-			auto stateCopy = valueTreeState.copyState();
+			applyPendingStateChunk();
+			auto stateCopy = copyStateLocked();
+
+			const juce::ScopedLock fileLock(presetFileLock);
+			const auto previousSidecars = findOwnSidecars(presetFile);
+			const auto sidecarFile = presetFile.getSiblingFile(presetFile.getFileNameWithoutExtension() + "." + juce::Uuid().toString() + "." + binaryDataExtension);
+
+			// The sidecar is committed before the preset that refers to it, so a failure never leaves a preset pointing at missing data.
+			if (!writeBinaryPropertiesOutOfLine(stateCopy, sidecarFile)) {
+				DBG("Failed to write preset data: " + sidecarFile.getFullPathName());
+				jassertfalse;
+				return;
+			}
 
 			const auto xml = stateCopy.createXml();
 			if (!xml->writeTo(presetFile)) {
 				DBG("Failed to write preset: " + presetFile.getFullPathName());
 				jassertfalse;
+				sidecarFile.deleteFile();
+				return;
 			}
+
+			for (const auto& previousSidecar : previousSidecars)
+				previousSidecar.deleteFile();
+
+			const juce::ScopedLock sl(lock);
 			currentPresetName = presetFile.getFileNameWithoutExtension();
+			sendChangeMessage();
 		}
 
+		/**
+		*   @brief Loads a preset file. Binary properties stored in sidecar files are set as SidecarData objects backed by the memory-mapped sidecar,
+		*	so loading does not read them and they never go through base64 or the XML document.
+		**/
 		void loadPreset(const juce::File& presetFile) {
 			if (presetFile.getFullPathName().isEmpty())
 				return;
 
+			const juce::ScopedLock fileLock(presetFileLock);
 			if (!presetFile.exists()) {
 				DBG("Preset file does not exist: " + presetFile.getFullPathName());
 				jassertfalse;
@@ -53,17 +125,34 @@ namespace MyJUCEModules {
 			}
 
 			juce::XmlDocument xmlDocument{ presetFile };
-			auto valueTreeToLoad = juce::ValueTree::fromXml(*xmlDocument.getDocumentElement());
+			const auto xml = xmlDocument.getDocumentElement();
+			if (xml == nullptr) {
+				DBG("Preset file is not valid XML: " + presetFile.getFullPathName());
+				jassertfalse;
+				return;
+			}
 
+			auto valueTreeToLoad = juce::ValueTree::fromXml(*xml);
+
+			SidecarMap sidecars;
+			if (!readBinaryPropertiesFromSidecars(valueTreeToLoad, presetFile, sidecars)) {
+				DBG("Failed to read preset data for: " + presetFile.getFullPathName());
+				jassertfalse;
+				return;
+			}
+
+			const juce::ScopedLock sl(lock);
+			applyPendingStateChunk();
 			valueTreeState.replaceState(valueTreeToLoad);
 			currentPresetName = presetFile.getFileNameWithoutExtension();
+			sendChangeMessage();
 		}
 
 		void loadNextPreset() {
 			const auto allPresets = getAllPresets();
 			if (allPresets.isEmpty())
 				return;
-			const auto currentPresetIndex = allPresets.indexOf(currentPresetName);
+			const auto currentPresetIndex = allPresets.indexOf(getCurrentPresetName());
 			const auto nextPresetIndex = (currentPresetIndex + 1) % allPresets.size();
 			juce::File nextPresetFile(defaultDirectory.getChildFile(allPresets.getReference(nextPresetIndex) + "." + extension));
 			loadPreset(nextPresetFile);
@@ -73,7 +162,7 @@ namespace MyJUCEModules {
 			const auto allPresets = getAllPresets();
 			if (allPresets.isEmpty())
 				return;
-			const auto currentPresetIndex = allPresets.indexOf(currentPresetName);
+			const auto currentPresetIndex = allPresets.indexOf(getCurrentPresetName());
 			const auto numPresets = allPresets.size();
 			const auto previousPresetIndex = (currentPresetIndex - 1 + numPresets) % numPresets;
 			juce::File previousPresetFile(defaultDirectory.getChildFile(allPresets.getReference(previousPresetIndex) + "." + extension));
@@ -81,7 +170,9 @@ namespace MyJUCEModules {
 		}
 
 		void copyPreset() {
-			auto stateCopy = valueTreeState.copyState();
+			applyPendingStateChunk();
+			auto stateCopy = copyStateLocked();
+			embedBinaryData(stateCopy);
 			const auto xml = stateCopy.createXml();
 			xml->setAttribute("pluginName", JucePlugin_Name);
 			juce::SystemClipboard::copyTextToClipboard(xml->toString());			
@@ -89,14 +180,22 @@ namespace MyJUCEModules {
 		}
 
 		void pastePreset() {
-			auto clipboardText = juce::SystemClipboard::getTextFromClipboard();
-			if (auto xml = juce::parseXML(clipboardText)) {
+			pastePreset(juce::SystemClipboard::getTextFromClipboard());
+		}
+
+		/**
+		*   @brief Loads a preset from text in the format written by copyPreset().
+		**/
+		void pastePreset(const juce::String& presetText) {
+			if (auto xml = juce::parseXML(presetText)) {
 				if (xml->getStringAttribute("pluginName") != JucePlugin_Name) {
 					DBG("Preset was not copied from this plugin");
 					return;
 				}
 				else {
 					auto valueTreeToLoad = juce::ValueTree::fromXml(*xml);
+					const juce::ScopedLock sl(lock);
+					applyPendingStateChunk();
 					valueTreeState.replaceState(valueTreeToLoad);
 				}
 			}
@@ -106,37 +205,412 @@ namespace MyJUCEModules {
 		}
 
 		juce::StringArray getAllPresets() const {
-			juce::StringArray presets;
-			const auto fileArray = defaultDirectory.findChildFiles(juce::File::TypesOfFileToFind::findFiles, false, "*." + extension);
+			return findPresets(defaultDirectory, extension);
+		}
 
-			for (const auto& presetFile : fileArray) {
-				presets.add(presetFile.getFileNameWithoutExtension());
+		/**
+		*   @brief Lists the names of the presets in a directory. Only touches the file system, so it can be called from a background thread.
+		*	@param shouldStop Optional, checked before each directory entry. The scan returns what it has found so far once it returns true.
+		**/
+		static juce::StringArray findPresets(const juce::File& directory, const juce::String& presetExtension, const std::function<bool()>& shouldStop = nullptr) {
+			juce::StringArray presets;
+			for (const auto& entry : juce::RangedDirectoryIterator(directory, false, "*." + presetExtension, juce::File::TypesOfFileToFind::findFiles)) {
+				if (shouldStop != nullptr && shouldStop())
+					break;
+				presets.add(entry.getFile().getFileNameWithoutExtension());
 			}
 			return presets;
 		}
 
 		juce::String getCurrentPresetName() const {
-			return currentPresetName;
+			const juce::ScopedLock sl(lock);
+			return pendingStateChunk != nullptr ? pendingStateChunk->presetName : currentPresetName;
+		}
+
+		juce::String getCurrentConfig() const {
+			const juce::ScopedLock sl(lock);
+			return pendingStateChunk != nullptr ? pendingStateChunk->config : currentConfig;
 		}
 
 		void switchToConfig(juce::String configName) {
+			const juce::ScopedLock sl(lock);
+			applyPendingStateChunk();
 			if (configName != currentConfig) {
 				auto stateCopy = valueTreeState.copyState();
 				valueTreeState.replaceState(otherValueTree);
 
 				otherValueTree = stateCopy;
 				currentConfig = configName;
+				otherConfigInitialised = true;
+				sendChangeMessage();
 			}
 		}
 
 		void copyCurrentConfigToOther() {
+			const juce::ScopedLock sl(lock);
+			applyPendingStateChunk();
 			otherValueTree = valueTreeState.copyState();
+			otherConfigInitialised = true;
+		}
+
+		/**
+		*   @brief Makes the other configuration a copy of the current one, unless it was already set by an A/B action or a restored state chunk.
+		**/
+		void initialiseOtherConfig() {
+			const juce::ScopedLock sl(lock);
+			applyPendingStateChunk();
+			if (!otherConfigInitialised)
+				copyCurrentConfigToOther();
+		}
+
+		/**
+		*   @brief Writes the current state, the other A/B configuration, the current preset name and config into a compact binary chunk.
+		*	Meant to be called from the processor's getStateInformation().
+		*	@param destData Block the chunk is written to, replacing its previous contents.
+		*	@param compress If true, the payload is GZIP-compressed. Worth it for large states, slower to write.
+		**/
+		void getStateChunk(juce::MemoryBlock& destData, bool compress = false) const {
+			StateChunkContents contents;
+			{
+				const juce::ScopedLock sl(lock);
+				if (pendingStateChunk != nullptr) {
+					// Copied as well, since applying the pending chunk hands its trees to the APVTS.
+					contents.presetName = pendingStateChunk->presetName;
+					contents.config = pendingStateChunk->config;
+					contents.state = pendingStateChunk->state.createCopy();
+					contents.other = pendingStateChunk->other.createCopy();
+				}
+				else {
+					contents.presetName = currentPresetName;
+					contents.config = currentConfig;
+					contents.state = valueTreeState.copyState();
+					// A later switchToConfig() hands otherValueTree to the APVTS, which then changes it, so this needs its own copy.
+					contents.other = otherValueTree.createCopy();
+				}
+			}
+			embedBinaryData(contents.state);
+			embedBinaryData(contents.other);
+
+			// The payload size goes in the header so that a truncated chunk can be told apart from a complete one.
+			juce::MemoryOutputStream payload;
+			writeStateChunkPayload(payload, contents);
+
+			destData.reset();
+			juce::MemoryOutputStream stream{ destData, false };
+
+			stream.writeInt(stateChunkMagic);
+			stream.writeInt(stateChunkVersion);
+			stream.writeInt(compress ? stateChunkCompressedFlag : 0);
+			stream.writeInt((int)payload.getDataSize());
+
+			if (compress) {
+				juce::GZIPCompressorOutputStream compressedStream{ stream };
+				compressedStream.write(payload.getData(), payload.getDataSize());
+			}
+			else {
+				stream.write(payload.getData(), payload.getDataSize());
+			}
+		}
+
+		/**
+		*   @brief Restores the state written by getStateChunk(). Meant to be called from the processor's setStateInformation().
+		*	If the APVTS has an UndoManager and this is not the message thread, the chunk is applied on the message thread, see the class description.
+		*	@param data Pointer to the chunk data.
+		*	@param sizeInBytes Size of the chunk.
+		*	@return False if the data is not a complete, valid chunk for this plugin, in which case nothing is changed.
+		**/
+		bool setStateChunk(const void* data, int sizeInBytes) {
+			if (data == nullptr || sizeInBytes < stateChunkHeaderSize)
+				return false;
+
+			juce::MemoryInputStream stream{ data, (size_t)sizeInBytes, false };
+
+			if (stream.readInt() != stateChunkMagic)
+				return false;
+
+			const auto version = stream.readInt();
+			if (version < 1 || version > stateChunkVersion) {
+				DBG("State chunk version is not supported by this preset manager");
+				return false;
+			}
+
+			const auto flags = stream.readInt();
+			const auto payloadSize = stream.readInt();
+			if (payloadSize < 0)
+				return false;
+
+			juce::MemoryBlock decompressedPayload;
+			const void* payloadData = juce::addBytesToPointer(data, stateChunkHeaderSize);
+			auto availableSize = (juce::int64)sizeInBytes - stateChunkHeaderSize;
+			if ((flags & stateChunkCompressedFlag) != 0) {
+				// Reads one byte more than announced, so that a payload longer than its header says is caught too.
+				juce::GZIPDecompressorInputStream decompressedStream{ stream };
+				decompressedStream.readIntoMemoryBlock(decompressedPayload, (juce::pointer_sized_int)payloadSize + 1);
+				payloadData = decompressedPayload.getData();
+				availableSize = (juce::int64)decompressedPayload.getSize();
+			}
+
+			if (availableSize != payloadSize) {
+				DBG("State chunk is truncated or corrupted");
+				return false;
+			}
+
+			StateChunkContents contents;
+			juce::MemoryInputStream payloadStream{ payloadData, (size_t)payloadSize, false };
+			if (!readStateChunkPayload(payloadStream, contents))
+				return false;
+
+			if (valueTreeState.undoManager != nullptr && !juce::MessageManager::existsAndIsCurrentThread()) {
+				{
+					const juce::ScopedLock sl(lock);
+					pendingStateChunk = std::make_unique<StateChunkContents>(std::move(contents));
+				}
+				triggerAsyncUpdate();
+				return true;
+			}
+
+			const juce::ScopedLock sl(lock);
+			pendingStateChunk.reset();
+			applyStateChunk(contents);
+			return true;
+		}
+
+		/**
+		*   @brief Returns a binary property of a tree, whether it was loaded from a sidecar or set as a MemoryBlock, or nullptr if it is neither.
+		*	Sidecar data is returned without copying; a MemoryBlock property is copied, so the result never depends on the tree staying unchanged.
+		**/
+		static SidecarData::Ptr getBinaryProperty(const juce::ValueTree& tree, const juce::Identifier& name) {
+			const auto& value = tree.getProperty(name);
+			if (auto* sidecarData = dynamic_cast<SidecarData*>(value.getObject()))
+				return sidecarData;
+			if (const auto* block = value.getBinaryData())
+				return new SidecarData(*block);
+			return nullptr;
+		}
+
+		/**
+		*   @brief Replaces the SidecarData properties of a tree by MemoryBlocks. createXml() and writeToStream() cannot write var objects,
+		*	so call this on a copy of the state before serialising it yourself. getStateChunk() and copyPreset() already do.
+		**/
+		static void embedBinaryData(juce::ValueTree& tree) {
+			for (auto child : tree)
+				embedBinaryData(child);
+
+			for (auto i = tree.getNumProperties(); --i >= 0;) {
+				const auto name = tree.getPropertyName(i);
+				if (const SidecarData::Ptr sidecarData = dynamic_cast<SidecarData*>(tree.getProperty(name).getObject()))
+					tree.setProperty(name, sidecarData->toMemoryBlock(), nullptr);
+			}
 		}
 
 	private:
+		using SidecarMap = std::map<juce::String, std::shared_ptr<juce::MemoryMappedFile>>;
+
+		/**
+		*   @brief Type of the nodes that replace out of line binary properties in preset files. Reserved: the state must not use it for its own nodes.
+		*	The node holds the property name, the sidecar file name relative to the preset, and the offset and size of the data in the sidecar.
+		**/
+		static constexpr const char* binaryReferenceType = "MyJUCEModules_PresetBinaryData";
+
+		/**
+		*   @brief Moves the large binary properties of a tree to a sidecar file, leaving reference nodes in their place.
+		*	Does not create the sidecar if there is nothing to move.
+		**/
+		bool writeBinaryPropertiesOutOfLine(juce::ValueTree& tree, const juce::File& sidecarFile) const {
+			juce::TemporaryFile sidecarTemp{ sidecarFile };
+			{
+				juce::FileOutputStream stream{ sidecarTemp.getFile() };
+				if (stream.failedToOpen())
+					return false;
+
+				moveLargeBinaryProperties(tree, stream, sidecarFile.getFileName());
+				stream.flush();
+
+				if (stream.getStatus().failed())
+					return false;
+				if (stream.getPosition() == 0)
+					return true;
+			}
+			return sidecarTemp.overwriteTargetFileWithTemporary();
+		}
+
+		void moveLargeBinaryProperties(juce::ValueTree& tree, juce::OutputStream& stream, const juce::String& sidecarName) const {
+			for (auto child : tree)
+				moveLargeBinaryProperties(child, stream, sidecarName);
+
+			for (auto i = tree.getNumProperties(); --i >= 0;) {
+				const auto name = tree.getPropertyName(i);
+				const auto binaryData = getBinaryPropertyData(tree.getProperty(name));
+				if (binaryData.first == nullptr)
+					continue;
+
+				if (binaryData.second < outOfLineBinarySize) {
+					// Sidecar data that is now below the threshold is embedded, as the XML cannot hold a var object.
+					if (tree.getProperty(name).isObject())
+						tree.setProperty(name, juce::MemoryBlock(binaryData.first, binaryData.second), nullptr);
+					continue;
+				}
+
+				juce::ValueTree reference{ binaryReferenceType };
+				reference.setProperty("property", name.toString(), nullptr);
+				reference.setProperty("file", sidecarName, nullptr);
+				reference.setProperty("offset", stream.getPosition(), nullptr);
+				reference.setProperty("size", (juce::int64)binaryData.second, nullptr);
+				stream.write(binaryData.first, binaryData.second);
+
+				tree.removeProperty(name, nullptr);
+				tree.appendChild(reference, nullptr);
+			}
+		}
+
+		/**
+		*   @brief Returns the bytes of a MemoryBlock or SidecarData property without copying them, or nullptr if it is neither.
+		*	Only valid until the property changes.
+		**/
+		static std::pair<const void*, size_t> getBinaryPropertyData(const juce::var& value) {
+			if (const auto* sidecarData = dynamic_cast<const SidecarData*>(value.getObject()))
+				return { sidecarData->getData(), sidecarData->getSize() };
+			if (const auto* block = value.getBinaryData())
+				return { block->getData(), block->getSize() };
+			return { nullptr, 0 };
+		}
+
+		/**
+		*   @brief Replaces the reference nodes of a tree read from a preset by SidecarData properties pointing into the mapped sidecars.
+		*	@return False if a sidecar is missing or a reference does not fit in it.
+		**/
+		bool readBinaryPropertiesFromSidecars(juce::ValueTree& tree, const juce::File& presetFile, SidecarMap& sidecars) const {
+			for (auto i = tree.getNumChildren(); --i >= 0;) {
+				auto child = tree.getChild(i);
+				if (!child.hasType(binaryReferenceType)) {
+					if (!readBinaryPropertiesFromSidecars(child, presetFile, sidecars))
+						return false;
+					continue;
+				}
+
+				const auto sidecarFile = getSidecarFile(child["file"].toString(), presetFile);
+				if (sidecarFile == juce::File())
+					return false;
+
+				auto& mappedFile = sidecars[sidecarFile.getFullPathName()];
+				if (mappedFile == nullptr)
+					mappedFile = std::make_shared<juce::MemoryMappedFile>(sidecarFile, juce::MemoryMappedFile::readOnly);
+
+				const auto offset = (juce::int64)child["offset"];
+				const auto size = (juce::int64)child["size"];
+				const auto name = child["property"].toString();
+				if (mappedFile->getData() == nullptr || name.isEmpty() || offset < 0 || size < 0 || offset + size > (juce::int64)mappedFile->getSize())
+					return false;
+
+				tree.setProperty(name, new SidecarData(mappedFile, offset, (size_t)size), nullptr);
+				tree.removeChild(i, nullptr);
+			}
+			return true;
+		}
+
+		/**
+		*   @brief Lists the sidecars written for a preset by previous saves, so they can be removed once it has been overwritten.
+		*	Goes by name rather than by what the old preset file refers to, so a copied or edited preset never gets another preset's data deleted.
+		**/
+		juce::Array<juce::File> findOwnSidecars(const juce::File& presetFile) const {
+			juce::Array<juce::File> sidecars;
+			for (const auto& file : presetFile.getParentDirectory().findChildFiles(juce::File::findFiles, false, "*." + binaryDataExtension))
+				if (getSidecarFile(file.getFileName(), presetFile) == file)
+					sidecars.add(file);
+			return sidecars;
+		}
+
+		/**
+		*   @brief Resolves a sidecar file name for a preset. Only <preset name>.<uuid>.<binaryDataExtension> names are accepted,
+		*	so a preset can only refer to sidecars written for it, in its own directory.
+		**/
+		juce::File getSidecarFile(const juce::String& fileName, const juce::File& presetFile) const {
+			const auto prefix = presetFile.getFileNameWithoutExtension() + ".";
+			const auto suffix = "." + binaryDataExtension;
+			if (!fileName.startsWith(prefix) || !fileName.endsWith(suffix))
+				return {};
+
+			const auto uuid = fileName.substring(prefix.length(), fileName.length() - suffix.length());
+			if (uuid.length() != 32 || !uuid.containsOnly("0123456789abcdef"))
+				return {};
+
+			return presetFile.getSiblingFile(fileName);
+		}
+
+		static constexpr int stateChunkMagic = 0x4d504241; // "ABPM" as written by OutputStream::writeInt()
+		static constexpr int stateChunkVersion = 1;
+		static constexpr int stateChunkCompressedFlag = 1;
+		static constexpr int stateChunkHeaderSize = 4 * (int)sizeof(int);
+
+		struct StateChunkContents {
+			juce::String presetName, config;
+			juce::ValueTree state, other;
+		};
+
+		static void writeStateChunkPayload(juce::OutputStream& stream, const StateChunkContents& contents) {
+			stream.writeString(contents.presetName);
+			stream.writeString(contents.config);
+			contents.state.writeToStream(stream);
+			contents.other.writeToStream(stream);
+		}
+
+		bool readStateChunkPayload(juce::InputStream& stream, StateChunkContents& contents) const {
+			contents.presetName = stream.readString();
+			contents.config = stream.readString() == "B" ? "B" : "A";
+			contents.state = juce::ValueTree::readFromStream(stream);
+			contents.other = juce::ValueTree::readFromStream(stream);
+
+			if (!contents.state.hasType(stateType) || !contents.other.hasType(stateType)) {
+				DBG("State chunk does not contain both A/B states for this plugin");
+				return false;
+			}
+
+			if (!stream.isExhausted()) {
+				DBG("State chunk payload does not match its contents");
+				return false;
+			}
+
+			return true;
+		}
+
+		/** Applies a decoded chunk. Must be called with the lock held. */
+		void applyStateChunk(const StateChunkContents& contents) {
+			valueTreeState.replaceState(contents.state);
+			otherValueTree = contents.other;
+			currentPresetName = contents.presetName;
+			currentConfig = contents.config;
+			otherConfigInitialised = true;
+			sendChangeMessage();
+		}
+
+		/** Applies a chunk restored off the message thread, if one is waiting. Must be called on the message thread. */
+		void applyPendingStateChunk() {
+			const juce::ScopedLock sl(lock);
+			if (pendingStateChunk != nullptr) {
+				const auto contents = std::move(pendingStateChunk);
+				applyStateChunk(*contents);
+			}
+		}
+
+		void handleAsyncUpdate() override {
+			applyPendingStateChunk();
+		}
+
+		juce::ValueTree copyStateLocked() const {
+			const juce::ScopedLock sl(lock);
+			return valueTreeState.copyState();
+		}
+
 		juce::AudioProcessorValueTreeState& valueTreeState;
+		const juce::Identifier stateType;
 		juce::String currentConfig = "A";
 		juce::ValueTree otherValueTree;
+		bool otherConfigInitialised = false;
 		juce::String currentPresetName;
+		// A chunk restored off the message thread while the APVTS has an UndoManager, see setStateChunk().
+		std::unique_ptr<StateChunkContents> pendingStateChunk;
+		// Guards the state together with the members above. presetFileLock only serialises preset file I/O, so getters never wait on the disk.
+		mutable juce::CriticalSection lock;
+		juce::CriticalSection presetFileLock;
 	};
 }
@@ -0,0 +1,100 @@
+#include "TestHelpers.h"
+#include "../../GUI/Components.h"
+
+namespace MyJUCEModulesTests {
+	/**
+	*   @brief Measures how long a PluginPanel takes to construct and how long until its icons and full preset list are attached.
+	*	Needs a display, e.g. run it under xvfb-run on a headless machine.
+	**/
+	class EditorOpenBenchmark : public juce::UnitTest
+	{
+	public:
+		EditorOpenBenchmark() : juce::UnitTest("PluginPanel editor open", "Editor") {}
+
+		void runTest() override {
+			constexpr int numPresets = 500;
+			constexpr int numRuns = 20;
+
+			TemporaryPresetDirectory presetDirectory;
+			TestProcessor processor;
+			MyJUCEModules::PresetManager presetManager(processor.apvts, presetDirectory.directory);
+			for (auto i = 0; i < numPresets; i++)
+				presetManager.savePreset(presetDirectory.directory.getChildFile("Preset " + juce::String(i) + "." + presetManager.extension));
+
+			beginTest("Icon parsing and building");
+			{
+				MyJUCEModules::PluginPanelResources resources;
+				const auto parseMs = medianMilliseconds(1, [&] { resources.parseIcons(); });
+				const auto buildMs = medianMilliseconds(1, [&] {
+					for (auto i = 0; i < MyJUCEModules::PluginPanelResources::numIcons; i++)
+						resources.getIcon((MyJUCEModules::PluginPanelResources::Icon)i);
+				});
+				logMessage("SVG parse (background thread): " + juce::String(parseMs, 3) + " ms, Drawable build (message thread, first editor only): " + juce::String(buildMs, 3) + " ms");
+			}
+
+			beginTest("First editor open");
+			{
+				auto timings = openPanel(presetManager, processor, numPresets);
+				logMessage(describe(timings));
+				expect(timings.ready, "panel did not finish loading");
+			}
+
+			beginTest("Further editor opens");
+			{
+				// Keeps the shared panel resources alive, as an already open editor would.
+				MyJUCEModules::PluginPanel firstPanel(presetManager, processor.undoManager, processor.apvts);
+
+				std::vector<double> constructMs, readyMs;
+				for (auto i = 0; i < numRuns; i++) {
+					auto timings = openPanel(presetManager, processor, numPresets);
+					expect(timings.ready, "panel did not finish loading");
+					constructMs.push_back(timings.constructMs);
+					readyMs.push_back(timings.readyMs);
+				}
+				std::sort(constructMs.begin(), constructMs.end());
+				std::sort(readyMs.begin(), readyMs.end());
+				logMessage("Median of " + juce::String(numRuns) + " opens: " + describe({ constructMs[constructMs.size() / 2], readyMs[readyMs.size() / 2], true }));
+			}
+		}
+
+	private:
+		struct Timings {
+			double constructMs = 0.0, readyMs = 0.0;
+			bool ready = false;
+		};
+
+		static juce::String describe(const Timings& timings) {
+			return "constructor " + juce::String(timings.constructMs, 3) + " ms, icons and preset list attached after " + juce::String(timings.readyMs, 3) + " ms";
+		}
+
+		static Timings openPanel(MyJUCEModules::PresetManager& presetManager, TestProcessor& processor, int numPresets) {
+			Timings timings;
+			const auto start = juce::Time::getHighResolutionTicks();
+			auto elapsedMs = [start] { return juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start) * 1000.0; };
+
+			MyJUCEModules::PluginPanel panel(presetManager, processor.undoManager, processor.apvts);
+			timings.constructMs = elapsedMs();
+
+			for (auto i = 0; i < 10000 && !isReady(panel, numPresets); i++)
+				juce::MessageManager::getInstance()->runDispatchLoopUntil(1);
+
+			timings.readyMs = elapsedMs();
+			timings.ready = isReady(panel, numPresets);
+			return timings;
+		}
+
+		static bool isReady(juce::Component& panel, int numPresets) {
+			for (auto* child : panel.getChildren()) {
+				if (auto* comboBox = dynamic_cast<juce::ComboBox*>(child))
+					if (comboBox->getNumItems() < numPresets)
+						return false;
+				if (auto* button = dynamic_cast<juce::DrawableButton*>(child))
+					if (button->getNormalImage() == nullptr)
+						return false;
+			}
+			return true;
+		}
+	};
+
+	static EditorOpenBenchmark editorOpenBenchmark;
+}
@@ -0,0 +1,24 @@
+#include "JuceHeader.h"
+
+// Runs every test, or only the category given as first argument ("PresetManager", "Benchmarks", "Stress" or "Editor").
+int main(int argc, char* argv[])
+{
+	juce::ScopedJuceInitialiser_GUI juceInitialiser;
+
+	juce::UnitTestRunner runner;
+	runner.setAssertOnFailure(false);
+
+	if (argc > 1)
+		runner.runTestsInCategory(argv[1]);
+	else
+		runner.runAllTests();
+
+	if (runner.getNumResults() == 0)
+		return 1;
+
+	for (auto i = 0; i < runner.getNumResults(); i++)
+		if (runner.getResult(i)->failures > 0)
+			return 1;
+
+	return 0;
+}
@@ -0,0 +1,7 @@
+#pragma once
+
+#include "JuceHeader.h"
+
+// Parameter IDs the GUI modules expect the plugin to define.
+const juce::String g_bypassID{ "bypass" };
+const juce::String g_osFactorID{ "osFactor" };
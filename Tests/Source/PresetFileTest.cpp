@@ -0,0 +1,187 @@
+#include "TestHelpers.h"
+#include "../../PresetManager/PresetManager.h"
+
+namespace MyJUCEModulesTests {
+	/**
+	*   @brief Checks that presets with large binary properties round trip through their sidecar files and keep the state self-contained.
+	**/
+	class PresetFileTest : public juce::UnitTest
+	{
+	public:
+		PresetFileTest() : juce::UnitTest("PresetManager preset files", "PresetManager") {}
+
+		void runTest() override {
+			TemporaryPresetDirectory presetDirectory;
+			TestProcessor processor;
+			MyJUCEModules::PresetManager presetManager(processor.apvts, presetDirectory.directory);
+			const auto presetFile = presetDirectory.directory.getChildFile("Large." + presetManager.extension);
+
+			const auto largeBlock = createBlock(1024 * 1024, 1);
+			const auto smallBlock = createBlock(16, 2);
+			setBinaryProperties(processor, largeBlock, smallBlock);
+
+			beginTest("Large properties go to a sidecar");
+			presetManager.savePreset(presetFile);
+			expect(presetFile.existsAsFile());
+			expectEquals(findSidecars(presetDirectory.directory, presetManager, "Large").size(), 1);
+			expect(presetFile.getSize() < (juce::int64)largeBlock.getSize(), "large property was embedded in the preset");
+			expect(getLargeBlock(processor) == largeBlock, "live state was modified by saving");
+
+			beginTest("Loading restores the data into the state");
+			setBinaryProperties(processor, createBlock(32, 3), createBlock(32, 4));
+			presetManager.loadPreset(presetFile);
+			expect(getLargeBlock(processor) == largeBlock);
+			expect(getSmallBlock(processor) == smallBlock);
+			expect(!processor.apvts.state.getChildWithName("MyJUCEModules_PresetBinaryData").isValid(), "reference node left in the state");
+
+			beginTest("Loaded sidecar data stays mapped until accessed");
+			expect(dynamic_cast<MyJUCEModules::PresetManager::SidecarData*>(processor.apvts.state["large"].getObject()) != nullptr,
+				"large property was copied out of the sidecar on load");
+			expect(processor.apvts.state["small"].getBinaryData() != nullptr, "small property should stay embedded");
+
+			beginTest("State chunks and copies embed the sidecar data");
+			{
+				TestProcessor restoredProcessor;
+				MyJUCEModules::PresetManager restoredPresetManager(restoredProcessor.apvts, presetDirectory.directory.getChildFile("restored"));
+				juce::MemoryBlock chunk;
+				presetManager.getStateChunk(chunk);
+				expect(restoredPresetManager.setStateChunk(chunk.getData(), (int)chunk.getSize()));
+				expect(restoredProcessor.apvts.state["large"].getBinaryData() != nullptr && *restoredProcessor.apvts.state["large"].getBinaryData() == largeBlock);
+
+				auto stateCopy = processor.apvts.copyState();
+				MyJUCEModules::PresetManager::embedBinaryData(stateCopy);
+				expect(stateCopy["large"].getBinaryData() != nullptr && *stateCopy["large"].getBinaryData() == largeBlock);
+				expect(processor.apvts.state["large"].isObject(), "embedding a copy changed the live state");
+			}
+
+			beginTest("Saving a loaded preset again writes its data to a new sidecar");
+			{
+				const auto resavedFile = presetDirectory.directory.getChildFile("Resaved." + presetManager.extension);
+				presetManager.savePreset(resavedFile);
+				setBinaryProperties(processor, createBlock(32, 3), createBlock(32, 4));
+				presetManager.loadPreset(resavedFile);
+				expect(getLargeBlock(processor) == largeBlock);
+				resavedFile.deleteFile();
+				for (const auto& sidecar : findSidecars(presetDirectory.directory, presetManager, "Resaved"))
+					sidecar.deleteFile();
+			}
+
+			beginTest("Overwriting a preset replaces its sidecar");
+			const auto firstSidecars = findSidecars(presetDirectory.directory, presetManager, "Large");
+			const auto otherLargeBlock = createBlock(512 * 1024, 5);
+			setBinaryProperties(processor, otherLargeBlock, smallBlock);
+			presetManager.savePreset(presetFile);
+			const auto secondSidecars = findSidecars(presetDirectory.directory, presetManager, "Large");
+			expectEquals(secondSidecars.size(), 1);
+			expect(firstSidecars.getFirst() != secondSidecars.getFirst(), "sidecar was rewritten in place");
+
+			presetManager.loadPreset(presetFile);
+			expect(getLargeBlock(processor) == otherLargeBlock);
+
+			beginTest("Presets without large properties have no sidecar");
+			processor.apvts.state.removeProperty("large", nullptr);
+			presetManager.savePreset(presetFile);
+			expectEquals(findSidecars(presetDirectory.directory, presetManager, "Large").size(), 0);
+
+			beginTest("A missing sidecar is rejected and the state is left unchanged");
+			{
+				const auto missingFile = saveLargePreset(presetManager, processor, presetDirectory.directory, "Missing", largeBlock);
+				findSidecars(presetDirectory.directory, presetManager, "Missing").getFirst().deleteFile();
+				expectLoadIsRejected(presetManager, processor, missingFile);
+			}
+
+			beginTest("A truncated sidecar is rejected and the state is left unchanged");
+			{
+				const auto truncatedFile = saveLargePreset(presetManager, processor, presetDirectory.directory, "Truncated", largeBlock);
+				const auto sidecar = findSidecars(presetDirectory.directory, presetManager, "Truncated").getFirst();
+				juce::MemoryBlock sidecarData;
+				sidecar.loadFileAsData(sidecarData);
+				sidecar.replaceWithData(sidecarData.getData(), sidecarData.getSize() / 2);
+				expectLoadIsRejected(presetManager, processor, truncatedFile);
+			}
+
+			beginTest("Saving over a duplicated preset keeps the original's sidecar");
+			{
+				const auto hallFile = saveLargePreset(presetManager, processor, presetDirectory.directory, "Hall", largeBlock);
+				const auto hallSidecars = findSidecars(presetDirectory.directory, presetManager, "Hall");
+				const auto hallCopyFile = presetDirectory.directory.getChildFile("Hall 2." + presetManager.extension);
+				expect(hallFile.copyFileTo(hallCopyFile));
+
+				// The copy refers to a sidecar named after another preset, so it is not trusted.
+				expectLoadIsRejected(presetManager, processor, hallCopyFile);
+
+				setBinaryProperties(processor, otherLargeBlock, smallBlock);
+				presetManager.savePreset(hallCopyFile);
+				expect(hallSidecars.getFirst().existsAsFile(), "the original preset's sidecar was deleted");
+				expectEquals(findSidecars(presetDirectory.directory, presetManager, "Hall").size(), 1);
+
+				presetManager.loadPreset(hallFile);
+				expectEquals(presetManager.getCurrentPresetName(), juce::String("Hall"));
+				expect(getLargeBlock(processor) == largeBlock);
+			}
+
+			beginTest("Saving over a preset referring to another file does not delete it");
+			{
+				const auto otherFile = saveLargePreset(presetManager, processor, presetDirectory.directory, "Other", smallBlock);
+				const auto forgedFile = presetDirectory.directory.getChildFile("Forged." + presetManager.extension);
+				auto forgedState = processor.apvts.copyState();
+				juce::ValueTree reference{ "MyJUCEModules_PresetBinaryData" };
+				reference.setProperty("property", "large", nullptr);
+				reference.setProperty("file", otherFile.getFileName(), nullptr);
+				reference.setProperty("offset", 0, nullptr);
+				reference.setProperty("size", 16, nullptr);
+				forgedState.appendChild(reference, nullptr);
+				expect(forgedState.createXml()->writeTo(forgedFile));
+
+				expectLoadIsRejected(presetManager, processor, forgedFile);
+				presetManager.savePreset(forgedFile);
+				expect(otherFile.existsAsFile(), "a file named by the overwritten preset was deleted");
+			}
+		}
+
+	private:
+		static juce::MemoryBlock createBlock(size_t size, int seed) {
+			juce::MemoryBlock block(size);
+			juce::Random random(seed);
+			random.fillBitsRandomly(block.getData(), block.getSize());
+			return block;
+		}
+
+		static void setBinaryProperties(TestProcessor& processor, const juce::MemoryBlock& large, const juce::MemoryBlock& small) {
+			processor.apvts.state.setProperty("large", large, nullptr);
+			processor.apvts.state.setProperty("small", small, nullptr);
+		}
+
+		static juce::MemoryBlock getBlock(TestProcessor& processor, const juce::Identifier& name) {
+			const auto data = MyJUCEModules::PresetManager::getBinaryProperty(processor.apvts.state, name);
+			return data != nullptr ? data->toMemoryBlock() : juce::MemoryBlock();
+		}
+
+		static juce::MemoryBlock getLargeBlock(TestProcessor& processor) { return getBlock(processor, "large"); }
+		static juce::MemoryBlock getSmallBlock(TestProcessor& processor) { return getBlock(processor, "small"); }
+
+		static juce::Array<juce::File> findSidecars(const juce::File& directory, const MyJUCEModules::PresetManager& presetManager, const juce::String& presetName = {}) {
+			return directory.findChildFiles(juce::File::findFiles, false, (presetName.isEmpty() ? "*" : presetName + ".*") + "." + presetManager.binaryDataExtension);
+		}
+
+		static juce::File saveLargePreset(MyJUCEModules::PresetManager& presetManager, TestProcessor& processor, const juce::File& directory,
+			const juce::String& name, const juce::MemoryBlock& large) {
+			const auto file = directory.getChildFile(name + "." + presetManager.extension);
+			setBinaryProperties(processor, large, createBlock(16, 6));
+			presetManager.savePreset(file);
+			return file;
+		}
+
+		void expectLoadIsRejected(MyJUCEModules::PresetManager& presetManager, TestProcessor& processor, const juce::File& presetFile) {
+			const auto marker = createBlock(32, 7);
+			setBinaryProperties(processor, marker, marker);
+			const auto presetName = presetManager.getCurrentPresetName();
+
+			presetManager.loadPreset(presetFile);
+			expect(getLargeBlock(processor) == marker, "state changed by a rejected load");
+			expectEquals(presetManager.getCurrentPresetName(), presetName, "preset name changed by a rejected load");
+		}
+	};
+
+	static PresetFileTest presetFileTest;
+}
@@ -0,0 +1,225 @@
+#include "TestHelpers.h"
+#include "../../PresetManager/PresetManager.h"
+
+#include <chrono>
+#include <cstdio>
+#include <thread>
+
+namespace MyJUCEModulesTests {
+	/**
+	*   @brief Log2 histogram of durations in nanoseconds, cheap enough to fill from a simulated audio thread.
+	**/
+	class LatencyHistogram
+	{
+	public:
+		void add(juce::int64 nanoseconds) {
+			// Bucket i holds durations below 2^i ns.
+			const auto bucket = nanoseconds <= 0 ? 0 : juce::jmin(numBuckets - 1, 64 - countLeadingZeros((juce::uint64)nanoseconds));
+			buckets[(size_t)bucket]++;
+			count++;
+			maximum = juce::jmax(maximum, nanoseconds);
+		}
+
+		/** Upper bound of the bucket holding the given fraction of the samples. */
+		juce::int64 getPercentile(double fraction) const {
+			const auto target = (juce::int64)std::ceil(fraction * (double)count);
+			juce::int64 seen = 0;
+			for (auto i = 0; i < numBuckets; i++) {
+				seen += buckets[(size_t)i];
+				if (seen >= target)
+					return (juce::int64)1 << i;
+			}
+			return maximum;
+		}
+
+		juce::String describe() const {
+			return juce::String(count) + " blocks, p50 <= " + juce::String(getPercentile(0.5)) + " ns, p99 <= " + juce::String(getPercentile(0.99))
+				+ " ns, p99.9 <= " + juce::String(getPercentile(0.999)) + " ns, max " + juce::String(maximum) + " ns";
+		}
+
+	private:
+		static int countLeadingZeros(juce::uint64 value) {
+			auto zeros = 0;
+			for (auto bit = (juce::uint64)1 << 63; bit != 0 && (value & bit) == 0; bit >>= 1)
+				zeros++;
+			return zeros;
+		}
+
+		static constexpr int numBuckets = 48;
+		std::array<juce::int64, numBuckets> buckets{};
+		juce::int64 count = 0, maximum = 0;
+	};
+
+	/**
+	*   @brief Runs preset loads, A/B switches, pastes and saves on the message thread against host state saves and restores on another thread
+	*	and parameter reads on a simulated audio thread, then reports inconsistent snapshots, stalls and the audio-thread read latency.
+	*	Every state used holds the same value in all float parameters, 0.25 or 0.75, so any snapshot mixing two states is detected.
+	*	Runs for PRESET_MANAGER_STRESS_SECONDS seconds (5 by default). Build with MY_JUCE_MODULES_TSAN=ON to have ThreadSanitizer report data races.
+	**/
+	class PresetManagerStressTest : public juce::UnitTest
+	{
+	public:
+		PresetManagerStressTest() : juce::UnitTest("PresetManager concurrency stress", "Stress") {}
+
+		void runTest() override {
+			beginTest("Concurrent preset, A/B, paste and host state operations");
+
+			const auto durationSeconds = juce::jmax(1, juce::SystemStats::getEnvironmentVariable("PRESET_MANAGER_STRESS_SECONDS", "5").getIntValue());
+			logMessage("Running for " + juce::String(durationSeconds) + " s");
+
+			TemporaryPresetDirectory presetDirectory;
+			// The processor under test has an UndoManager bound to its APVTS, as PluginPanel requires, and the message thread uses it
+			// like the panel's undo button does. Host restores on it are then applied on the message thread, see PresetManager::setStateChunk().
+			TestProcessor processor;
+			MyJUCEModules::PresetManager presetManager(processor.apvts, presetDirectory.directory);
+			// The mirror only decodes the chunks taken by the host thread so they can be checked there. It has no UndoManager, so its
+			// restores are applied on the host thread, which covers the other setStateChunk() path.
+			TestProcessor mirrorProcessor{ false };
+			MyJUCEModules::PresetManager mirror(mirrorProcessor.apvts, presetDirectory.directory.getChildFile("mirror"));
+
+			juce::StringArray presetNames, pasteTexts;
+			for (const auto value : values) {
+				processor.apvts.replaceState(processor.createStateWithValue(value));
+				for (auto i = 0; i < 4; i++) {
+					const auto name = "Preset " + juce::String(value) + " " + juce::String(i);
+					presetManager.savePreset(presetDirectory.directory.getChildFile(name + "." + presetManager.extension));
+					presetNames.add(name);
+				}
+				auto xml = processor.apvts.copyState().createXml();
+				xml->setAttribute("pluginName", JucePlugin_Name);
+				pasteTexts.add(xml->toString());
+			}
+			presetNames.add("Scratch");
+
+			processor.apvts.replaceState(processor.createStateWithValue(values[0]));
+			presetManager.copyCurrentConfigToOther();
+			presetManager.switchToConfig("B");
+			processor.apvts.replaceState(processor.createStateWithValue(values[1]));
+
+			std::atomic<bool> running{ true };
+			std::atomic<juce::int64> messageOps{ 0 }, hostOps{ 0 }, audioBlocks{ 0 };
+			std::atomic<int> inconsistentSnapshots{ 0 }, invalidValues{ 0 }, unknownPresetNames{ 0 }, failedRestores{ 0 };
+			juce::int64 mixedBlocks = 0;
+			LatencyHistogram audioLatency;
+
+			std::thread hostThread([&] {
+				juce::Random random(1);
+				juce::MemoryBlock chunk;
+				while (running) {
+					presetManager.getStateChunk(chunk, random.nextBool());
+
+					// Every chunk must hold two whole states, whatever the message thread was doing when it was taken.
+					if (!mirror.setStateChunk(chunk.getData(), (int)chunk.getSize()) || !isUniform(mirrorProcessor.apvts.copyState()))
+						inconsistentSnapshots++;
+					mirror.switchToConfig(mirror.getCurrentConfig() == "A" ? "B" : "A");
+					if (!isUniform(mirrorProcessor.apvts.copyState()))
+						inconsistentSnapshots++;
+
+					if (!isUniform(processor.apvts.copyState()))
+						inconsistentSnapshots++;
+
+					const auto presetName = presetManager.getCurrentPresetName();
+					if (presetName.isNotEmpty() && !presetNames.contains(presetName))
+						unknownPresetNames++;
+
+					if (random.nextInt(4) == 0 && !presetManager.setStateChunk(chunk.getData(), (int)chunk.getSize()))
+						failedRestores++;
+
+					hostOps++;
+				}
+			});
+
+			std::thread audioThread([&] {
+				std::vector<std::atomic<float>*> parameters;
+				for (auto i = 0; i < TestProcessor::numFloatParameters; i++)
+					parameters.push_back(processor.apvts.getRawParameterValue(TestProcessor::getFloatParameterID(i)));
+
+				while (running) {
+					const auto start = std::chrono::steady_clock::now();
+					auto first = parameters.front()->load(std::memory_order_relaxed);
+					auto mixed = false;
+					for (auto* parameter : parameters) {
+						const auto value = parameter->load(std::memory_order_relaxed);
+						if (value != values[0] && value != values[1])
+							invalidValues++;
+						mixed = mixed || value != first;
+					}
+					const auto elapsed = std::chrono::steady_clock::now() - start;
+
+					audioLatency.add(std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+					if (mixed)
+						mixedBlocks++;
+					audioBlocks++;
+					std::this_thread::yield();
+				}
+			});
+
+			// Reports a stall of any role, which with this lock layout means a deadlock, and aborts as there is no way to recover from one.
+			std::thread watchdog([&] {
+				juce::int64 lastMessageOps = -1, lastHostOps = -1, lastAudioBlocks = -1;
+				auto stalledSeconds = 0;
+				while (running) {
+					std::this_thread::sleep_for(std::chrono::seconds(1));
+					const auto progressed = messageOps != lastMessageOps && hostOps != lastHostOps && audioBlocks != lastAudioBlocks;
+					lastMessageOps = messageOps;
+					lastHostOps = hostOps;
+					lastAudioBlocks = audioBlocks;
+					stalledSeconds = progressed ? 0 : stalledSeconds + 1;
+					if (running && stalledSeconds >= 10) {
+						std::fprintf(stderr, "PresetManager stress test: no progress for 10 s (message %lld, host %lld, audio %lld), probable deadlock\n",
+							(long long)lastMessageOps, (long long)lastHostOps, (long long)lastAudioBlocks);
+						std::abort();
+					}
+				}
+			});
+
+			juce::Random random(2);
+			const auto end = juce::Time::getMillisecondCounterHiRes() + durationSeconds * 1000.0;
+			while (juce::Time::getMillisecondCounterHiRes() < end) {
+				switch (random.nextInt(7)) {
+					case 0: presetManager.loadPreset(presetDirectory.directory.getChildFile(presetNames[random.nextInt(presetNames.size() - 1)] + "." + presetManager.extension)); break;
+					case 1: presetManager.switchToConfig(random.nextBool() ? "A" : "B"); break;
+					case 2: presetManager.pastePreset(pasteTexts[random.nextInt(pasteTexts.size())]); break;
+					case 3: presetManager.copyCurrentConfigToOther(); break;
+					case 4: presetManager.savePreset(presetDirectory.directory.getChildFile("Scratch." + presetManager.extension)); break;
+					case 5: processor.undoManager.beginNewTransaction(); processor.undoManager.undo(); break;
+					default: juce::MessageManager::getInstance()->runDispatchLoopUntil(1); break;
+				}
+				messageOps++;
+			}
+
+			running = false;
+			hostThread.join();
+			audioThread.join();
+			watchdog.join();
+
+			logMessage("Message thread: " + juce::String(messageOps.load()) + " operations, host thread: " + juce::String(hostOps.load()) + " chunk saves");
+			logMessage("Audio thread parameter reads: " + audioLatency.describe());
+			logMessage("Audio blocks seeing parameters from two states: " + juce::String(mixedBlocks)
+				+ " (replaceState() updates the parameters one at a time, so this is expected)");
+
+			expectEquals(inconsistentSnapshots.load(), 0, "snapshots mixing two states");
+			expectEquals(invalidValues.load(), 0, "parameter values that no state holds");
+			expectEquals(unknownPresetNames.load(), 0, "torn preset names");
+			expectEquals(failedRestores.load(), 0, "chunks that could not be restored");
+			expect(hostOps > 0 && audioBlocks > 0 && messageOps > 0);
+		}
+
+	private:
+		static constexpr float values[2] = { 0.25f, 0.75f };
+
+		static bool isUniform(const juce::ValueTree& state) {
+			const auto first = (float)state.getChildWithProperty("id", TestProcessor::getFloatParameterID(0))["value"];
+			if (first != values[0] && first != values[1])
+				return false;
+
+			for (auto i = 1; i < TestProcessor::numFloatParameters; i++)
+				if ((float)state.getChildWithProperty("id", TestProcessor::getFloatParameterID(i))["value"] != first)
+					return false;
+
+			return true;
+		}
+	};
+
+	static PresetManagerStressTest presetManagerStressTest;
+}
@@ -0,0 +1,145 @@
+#include "TestHelpers.h"
+#include "../../PresetManager/PresetManager.h"
+
+#include <thread>
+
+namespace MyJUCEModulesTests {
+	/**
+	*   @brief Checks the PresetManager state chunk round trip and compares its size and encode/decode time with the copyState()/XML path.
+	**/
+	class StateChunkBenchmark : public juce::UnitTest
+	{
+	public:
+		StateChunkBenchmark() : juce::UnitTest("PresetManager state chunk vs XML", "Benchmarks") {}
+
+		void runTest() override {
+			TemporaryPresetDirectory presetDirectory;
+			TestProcessor processor;
+			MyJUCEModules::PresetManager presetManager(processor.apvts, presetDirectory.directory);
+
+			// A holds 0.25 and B holds 0.75 everywhere, so the chunk has to carry two different trees.
+			processor.apvts.replaceState(processor.createStateWithValue(0.25f));
+			presetManager.copyCurrentConfigToOther();
+			presetManager.switchToConfig("B");
+			processor.apvts.replaceState(processor.createStateWithValue(0.75f));
+
+			beginTest("Round trip keeps both configurations");
+			{
+				juce::MemoryBlock chunk;
+				presetManager.getStateChunk(chunk);
+
+				processor.apvts.replaceState(processor.createStateWithValue(0.5f));
+				presetManager.switchToConfig("A");
+
+				expect(presetManager.setStateChunk(chunk.getData(), (int)chunk.getSize()));
+				expectEquals(presetManager.getCurrentConfig(), juce::String("B"));
+				expectEquals(getFirstFloatParameter(processor), 0.75f);
+
+				presetManager.switchToConfig("A");
+				expectEquals(getFirstFloatParameter(processor), 0.25f);
+				presetManager.switchToConfig("B");
+			}
+
+			beginTest("Compressed round trip");
+			{
+				juce::MemoryBlock chunk;
+				presetManager.getStateChunk(chunk, true);
+				processor.apvts.replaceState(processor.createStateWithValue(0.5f));
+
+				expect(presetManager.setStateChunk(chunk.getData(), (int)chunk.getSize()));
+				expectEquals(getFirstFloatParameter(processor), 0.75f);
+			}
+
+			beginTest("Invalid chunks are rejected");
+			{
+				juce::MemoryBlock chunk;
+				presetManager.getStateChunk(chunk);
+
+				for (const auto version : { 0, -1, 2 }) {
+					auto badVersion = chunk;
+					const auto versionLE = juce::ByteOrder::swapIfBigEndian((juce::uint32)version);
+					badVersion.copyFrom(&versionLE, (int)sizeof(int), sizeof(versionLE)); // version follows the magic number
+					expect(!presetManager.setStateChunk(badVersion.getData(), (int)badVersion.getSize()), "version " + juce::String(version) + " accepted");
+				}
+
+				const char garbage[] = "not a state chunk at all";
+				expect(!presetManager.setStateChunk(garbage, (int)sizeof(garbage)));
+				expect(!presetManager.setStateChunk(chunk.getData(), 8));
+
+				// Truncated chunks must leave the state unchanged.
+				for (const auto compress : { false, true }) {
+					juce::MemoryBlock fullChunk;
+					presetManager.getStateChunk(fullChunk, compress);
+					presetManager.switchToConfig("A");
+					processor.apvts.replaceState(processor.createStateWithValue(0.5f));
+
+					// Cuts just after the header, halfway through and one byte before the end, where only the other tree is incomplete.
+					for (const auto size : { 17, (int)fullChunk.getSize() / 2, (int)fullChunk.getSize() - 1 }) {
+						expect(!presetManager.setStateChunk(fullChunk.getData(), size), juce::String(compress ? "compressed" : "plain") + " chunk cut to " + juce::String(size) + " bytes accepted");
+						expectEquals(presetManager.getCurrentConfig(), juce::String("A"));
+						expectEquals(getFirstFloatParameter(processor), 0.5f);
+					}
+
+					expect(presetManager.setStateChunk(fullChunk.getData(), (int)fullChunk.getSize()));
+				}
+			}
+
+			beginTest("Restores off the message thread are applied on it");
+			{
+				juce::MemoryBlock chunk;
+				presetManager.getStateChunk(chunk);
+				presetManager.switchToConfig("A");
+				processor.apvts.replaceState(processor.createStateWithValue(0.5f));
+
+				// The APVTS has an UndoManager, so a host thread restore must not call replaceState() there.
+				auto restored = false;
+				std::thread hostThread([&] { restored = presetManager.setStateChunk(chunk.getData(), (int)chunk.getSize()); });
+				hostThread.join();
+				expect(restored);
+				expectEquals(getFirstFloatParameter(processor), 0.5f);
+				expectEquals(presetManager.getCurrentConfig(), juce::String("B"), "getters should report the restored chunk");
+
+				juce::MessageManager::getInstance()->runDispatchLoopUntil(50);
+				expectEquals(getFirstFloatParameter(processor), 0.75f);
+				expectEquals(presetManager.getCurrentConfig(), juce::String("B"));
+			}
+
+			beginTest("Size and encode/decode time against XML");
+			{
+				constexpr int numRuns = 200;
+				juce::MemoryBlock xmlData, chunk, compressedChunk;
+
+				const auto xmlEncode = medianMilliseconds(numRuns, [&] {
+					xmlData.reset();
+					juce::AudioProcessor::copyXmlToBinary(*processor.apvts.copyState().createXml(), xmlData);
+				});
+				const auto chunkEncode = medianMilliseconds(numRuns, [&] { presetManager.getStateChunk(chunk); });
+				const auto compressedEncode = medianMilliseconds(numRuns, [&] { presetManager.getStateChunk(compressedChunk, true); });
+
+				const auto xmlDecode = medianMilliseconds(numRuns, [&] {
+					if (auto xml = juce::AudioProcessor::getXmlFromBinary(xmlData.getData(), (int)xmlData.getSize()))
+						processor.apvts.replaceState(juce::ValueTree::fromXml(*xml));
+				});
+				const auto chunkDecode = medianMilliseconds(numRuns, [&] { presetManager.setStateChunk(chunk.getData(), (int)chunk.getSize()); });
+				const auto compressedDecode = medianMilliseconds(numRuns, [&] { presetManager.setStateChunk(compressedChunk.getData(), (int)compressedChunk.getSize()); });
+
+				logMessage("XML (active state only):  " + describe(xmlData.getSize(), xmlEncode, xmlDecode));
+				logMessage("State chunk (A and B):    " + describe(chunk.getSize(), chunkEncode, chunkDecode));
+				logMessage("Compressed chunk (A and B): " + describe(compressedChunk.getSize(), compressedEncode, compressedDecode));
+
+				expect(compressedChunk.getSize() < chunk.getSize());
+			}
+		}
+
+	private:
+		static float getFirstFloatParameter(TestProcessor& processor) {
+			return processor.apvts.getRawParameterValue(TestProcessor::getFloatParameterID(0))->load();
+		}
+
+		static juce::String describe(size_t sizeInBytes, double encodeMs, double decodeMs) {
+			return juce::String((int)sizeInBytes) + " bytes, encode " + juce::String(encodeMs, 4) + " ms, decode " + juce::String(decodeMs, 4) + " ms";
+		}
+	};
+
+	static StateChunkBenchmark stateChunkBenchmark;
+}
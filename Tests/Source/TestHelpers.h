@@ -0,0 +1,99 @@
+#pragma once
+
+#include "JuceHeader.h"
+#include "ParameterIDs.h"
+
+namespace MyJUCEModulesTests {
+	/**
+	*   @brief Minimal processor owning an AudioProcessorValueTreeState laid out like the plugins using these modules.
+	**/
+	class TestProcessor : public juce::AudioProcessor
+	{
+	public:
+		static constexpr int numFloatParameters = 32;
+
+		explicit TestProcessor(bool useUndoManager = true) : apvts(*this, useUndoManager ? &undoManager : nullptr, "PARAMETERS", createParameterLayout()) {}
+
+		static juce::String getFloatParameterID(int index) {
+			return "param" + juce::String(index);
+		}
+
+		/**
+		*   @brief Returns a copy of the current state with every float parameter set to value, as a preset would hold it.
+		**/
+		juce::ValueTree createStateWithValue(float value) {
+			auto state = apvts.copyState();
+			for (auto i = 0; i < numFloatParameters; i++) {
+				auto parameter = state.getChildWithProperty("id", getFloatParameterID(i));
+				if (!parameter.isValid()) {
+					parameter = juce::ValueTree("PARAM");
+					parameter.setProperty("id", getFloatParameterID(i), nullptr);
+					state.appendChild(parameter, nullptr);
+				}
+				parameter.setProperty("value", value, nullptr);
+			}
+			return state;
+		}
+
+		const juce::String getName() const override { return JucePlugin_Name; }
+		void prepareToPlay(double, int) override {}
+		void releaseResources() override {}
+		void processBlock(juce::AudioBuffer<float>&, juce::MidiBuffer&) override {}
+		juce::AudioProcessorEditor* createEditor() override { return nullptr; }
+		bool hasEditor() const override { return false; }
+		bool acceptsMidi() const override { return false; }
+		bool producesMidi() const override { return false; }
+		double getTailLengthSeconds() const override { return 0.0; }
+		int getNumPrograms() override { return 1; }
+		int getCurrentProgram() override { return 0; }
+		void setCurrentProgram(int) override {}
+		const juce::String getProgramName(int) override { return {}; }
+		void changeProgramName(int, const juce::String&) override {}
+		void getStateInformation(juce::MemoryBlock&) override {}
+		void setStateInformation(const void*, int) override {}
+
+		juce::UndoManager undoManager;
+		juce::AudioProcessorValueTreeState apvts;
+
+	private:
+		static juce::AudioProcessorValueTreeState::ParameterLayout createParameterLayout() {
+			juce::AudioProcessorValueTreeState::ParameterLayout layout;
+			layout.add(std::make_unique<juce::AudioParameterBool>(juce::ParameterID{ g_bypassID, 1 }, "Bypass", false));
+			layout.add(std::make_unique<juce::AudioParameterChoice>(juce::ParameterID{ g_osFactorID, 1 }, "Oversampling", juce::StringArray{ "x1", "x2", "x4" }, 0));
+			for (auto i = 0; i < numFloatParameters; i++)
+				layout.add(std::make_unique<juce::AudioParameterFloat>(juce::ParameterID{ getFloatParameterID(i), 1 }, getFloatParameterID(i), 0.0f, 1.0f, 0.5f));
+			return layout;
+		}
+
+		JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(TestProcessor)
+	};
+
+	/**
+	*   @brief Empty preset directory in the temp folder, deleted with its contents when going out of scope.
+	**/
+	struct TemporaryPresetDirectory
+	{
+		TemporaryPresetDirectory() : directory(juce::File::getSpecialLocation(juce::File::tempDirectory).getNonexistentChildFile("MyJUCEModulesTests", {}, false)) {
+			directory.createDirectory();
+		}
+		~TemporaryPresetDirectory() { directory.deleteRecursively(); }
+
+		const juce::File directory;
+	};
+
+	/**
+	*   @brief Runs fn numRuns times and returns the median wall-clock time of a run in milliseconds.
+	**/
+	template <typename Function>
+	double medianMilliseconds(int numRuns, Function&& fn) {
+		std::vector<double> times;
+		times.reserve((size_t)numRuns);
+		for (auto i = 0; i < numRuns; i++) {
+			const auto start = juce::Time::getHighResolutionTicks();
+			fn();
+			times.push_back(juce::Time::highResolutionTicksToSeconds(juce::Time::getHighResolutionTicks() - start) * 1000.0);
+		}
+		std::sort(times.begin(), times.end());
+		return times[times.size() / 2];
+	}
+}